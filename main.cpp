@@ -1,10 +1,21 @@
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
 #include <mysql.h>
 using namespace std;
 
-MYSQL *connection, mysql;
+// one connection per thread, trace replay runs several workers
+thread_local MYSQL *connection, mysql;
 
 /**
  * Structure for Student details
@@ -27,6 +38,8 @@ struct Course {
         year = 0;
         enrollment = 0;
         maxenrollment = 0;
+        waitlistposition = 0;
+        waitlistlength = 0;
     }
     string id;
     string name;
@@ -38,10 +51,232 @@ struct Course {
     
     int enrollment;
     int maxenrollment;
+    int waitlistposition;
+    int waitlistlength;
     string textbook;
     string lecturer;
     string classroom;
     string classtime;
+    vector<string> prerequisites;
+};
+
+/**
+ * Session trace file, enabled with --record <file>
+ */
+ofstream traceFile;
+
+/**
+ * Session id written into every trace line, replay keeps calls of one session in order
+ */
+string traceSession;
+
+/**
+ * Returns current time in microseconds since epoch
+ */
+long long getTimestampMicros()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Escape string for JSON output
+ */
+string jsonEscape(const string& value)
+{
+    string out;
+    for(size_t i=0;i<value.size();i++)
+    {
+        unsigned char c = value[i];
+        if(c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if(c == '\n')
+            out += "\\n";
+        else if(c == '\t')
+            out += "\\t";
+        else if(c < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else
+            out += c;
+    }
+    return out;
+}
+
+/**
+ * Records one db_* call into the trace file: session, operation name, parameters,
+ * start time, latency, number of result rows and stored procedure response if any.
+ * The line is written when the call goes out of scope, so early returns are covered.
+ *
+ * Line format:
+ *   {"session":"4242-1700000000000000","ts":1700000000000000,"op":"db_enroll_into",
+ *    "args":["INFO1003","Q1","2026","3213"],"us":412,"rows":1,"response":"OK"}
+ */
+struct TraceCall {
+    TraceCall(const string& op, const vector<string>& args) : op(op), args(args) {
+        rows = 0;
+        ts = getTimestampMicros();
+        start = chrono::steady_clock::now();
+    }
+    ~TraceCall() {
+        if(!traceFile.is_open())
+            return;
+        
+        long long us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        traceFile << "{\"session\":\"" << traceSession << "\",\"ts\":" << ts << ",\"op\":\"" << op << "\",\"args\":[";
+        for(size_t i=0;i<args.size();i++)
+            traceFile << (i ? "," : "") << "\"" << jsonEscape(args[i]) << "\"";
+        traceFile << "],\"us\":" << us << ",\"rows\":" << rows;
+        if(!response.empty())
+            traceFile << ",\"response\":\"" << jsonEscape(response) << "\"";
+        traceFile << "}" << endl;
+    }
+    string op;
+    vector<string> args;
+    size_t rows;
+    string response;
+    long long ts;
+    chrono::steady_clock::time_point start;
+};
+
+/**
+ * Search filters for CourseIndex
+ */
+struct CourseFilter {
+    CourseFilter() {
+        freeSeats = false;
+        prerequisitesMet = false;
+    }
+    bool freeSeats;
+    bool prerequisitesMet;
+    // courses passed by the student, used with prerequisitesMet
+    set<string> passed;
+};
+
+/**
+ * In-memory inverted index over loaded course list.
+ * Every word of UoSCode, UoSName, DeptId and lecturer name is stored with all its suffixes
+ * in one sorted list, so prefix and substring queries are a binary search plus a short scan.
+ * Build once per catalog load, the index owns its copy of the course list and
+ * search() returns positions in CourseIndex::courses.
+ */
+struct CourseIndex {
+    CourseIndex(const vector<Course>& courses) : courses(courses) {
+        for(size_t i=0;i<courses.size();i++)
+        {
+            addField(courses[i].id, i, 8);
+            addField(courses[i].name, i, 4);
+            addField(courses[i].lecturer, i, 2);
+            addField(courses[i].deptid, i, 2);
+        }
+        sort(entries.begin(), entries.end());
+    }
+    
+    /**
+     * Returns indexes of courses matching all words of the query, best match first.
+     * Empty query returns all courses passing the filter.
+     */
+    vector<size_t> search(const string& query, const CourseFilter& filter) const {
+        vector<string> words = tokenize(query);
+        vector<int> score(courses.size(), 0);
+        vector<bool> matched(courses.size(), true);
+        
+        for(size_t w=0;w<words.size();w++)
+        {
+            // best score of this word for each course
+            vector<int> best(courses.size(), 0);
+            const string& word = words[w];
+            
+            vector<Entry>::const_iterator it = lower_bound(entries.begin(), entries.end(), Entry(word, 0, 0, 0));
+            for(; it != entries.end() && it->text.compare(0, word.size(), word) == 0; ++it)
+            {
+                // exact word 3, word prefix 2, substring 1
+                int kind = it->offset > 0 ? 1 : (it->text.size() == word.size() ? 3 : 2);
+                best[it->course] = max(best[it->course], kind * it->weight);
+            }
+            
+            for(size_t i=0;i<courses.size();i++)
+            {
+                if(best[i] == 0)
+                    matched[i] = false;
+                score[i] += best[i];
+            }
+        }
+        
+        vector<size_t> result;
+        for(size_t i=0;i<courses.size();i++)
+            if(matched[i] && accept(courses[i], filter))
+                result.push_back(i);
+        
+        stable_sort(result.begin(), result.end(), [&](size_t a, size_t b) {
+            if(score[a] != score[b])
+                return score[a] > score[b];
+            return courses[a].id < courses[b].id;
+        });
+        return result;
+    }
+    
+    /**
+     * Split text into lowercase alphanumeric words
+     */
+    static vector<string> tokenize(const string& text) {
+        vector<string> words;
+        string word;
+        for(size_t i=0;i<=text.size();i++)
+        {
+            if(i < text.size() && isalnum((unsigned char)text[i]))
+                word += tolower((unsigned char)text[i]);
+            else if(!word.empty())
+            {
+                words.push_back(word);
+                word.clear();
+            }
+        }
+        return words;
+    }
+    
+    const vector<Course> courses;
+    
+private:
+    struct Entry {
+        Entry(const string& text, size_t course, int weight, size_t offset)
+            : text(text), course(course), weight(weight), offset(offset) {}
+        bool operator<(const Entry& other) const {
+            return text < other.text;
+        }
+        // suffix of the word starting at offset
+        string text;
+        size_t course;
+        int weight;
+        size_t offset;
+    };
+    
+    void addField(const string& value, size_t course, int weight) {
+        vector<string> words = tokenize(value);
+        for(size_t w=0;w<words.size();w++)
+            for(size_t offset=0;offset<words[w].size();offset++)
+                entries.push_back(Entry(words[w].substr(offset), course, weight, offset));
+    }
+    
+    static bool accept(const Course& course, const CourseFilter& filter) {
+        // enroll_student gives free seats to the waitlist first
+        if(filter.freeSeats && (course.enrollment >= course.maxenrollment || course.waitlistlength > 0))
+            return false;
+        if(filter.prerequisitesMet)
+        {
+            for(size_t i=0;i<course.prerequisites.size();i++)
+                if(!filter.passed.count(course.prerequisites[i]))
+                    return false;
+        }
+        return true;
+    }
+    
+    vector<Entry> entries;
 };
 
 /**
@@ -100,6 +335,17 @@ int getCurrentYear()
     return 1900+timePtr->tm_year;
 }
 
+/**
+ * Connect to portal database, each thread needs its own connection
+ */
+bool db_connect()
+{
+    mysql_init(&mysql);
+    connection = mysql_real_connect(&mysql, "localhost", "root", "123",
+                                    "project3-nudb", 0, 0, 0);
+    return connection != NULL;
+}
+
 /**
  * Create storage procedures
  */
@@ -119,17 +365,39 @@ void db_createProcedures()
     if(mysql_errno( connection ) || mysql_warning_count(connection))
         cout << mysql_error(&mysql) << endl;
     
+    // TABLE : waitlist
+    // Students waiting for a seat in a full offering, Id keeps FIFO order
+    string waitlist_sql = "CREATE TABLE IF NOT EXISTS waitlist ( \
+                            Id int NOT NULL AUTO_INCREMENT, \
+                            StudId int NOT NULL, \
+                            UoSCode char(8) NOT NULL, \
+                            Semester char(2) NOT NULL, \
+                            Year int NOT NULL, \
+                            PRIMARY KEY (Id), \
+                            UNIQUE KEY waitlist_student (UoSCode, Semester, Year, StudId), \
+                            KEY waitlist_order (UoSCode, Semester, Year, Id) \
+                          )";
+    mysql_query(&mysql, waitlist_sql.c_str());
+    if(mysql_errno( connection ) || mysql_warning_count(connection))
+        cout << mysql_error(&mysql) << endl;
+    
     // STORED PROCEDURE : enroll
     mysql_query(&mysql, "DROP procedure IF EXISTS `enroll_student`;");
     
     string enroll_sql = "CREATE DEFINER=`root`@`localhost` PROCEDURE `enroll_student`(IN in_course_id char(8), IN in_semester char(2), IN in_year int, IN in_student_id int) \n\
         BEGIN \n\
         DECLARE prerequisites varchar(256); \n\
+        DECLARE offering_count int; \n\
+        DECLARE next_student int DEFAULT NULL; \n\
         START TRANSACTION; \n\
+        # lock offering before any other read, withdraw_student and waitlist_student take the same lock \n\
+        SELECT COUNT(*) INTO offering_count FROM uosoffering WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year FOR UPDATE; \n\
+        # empty waitlist leaves next_student NULL \n\
+        SELECT StudId INTO next_student FROM waitlist WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year ORDER BY Id LIMIT 1 FOR UPDATE; \n\
         # check course exists \n\
-        IF (SELECT EXISTS( select UoSCode from uosoffering where UoSCode=in_course_id and Semester=in_semester and Year=in_year )) THEN \n\
-            # check enrollment places \n\
-            IF ( (select Enrollment<MaxEnrollment from uosoffering where UoSCode=in_course_id and Semester=in_semester and Year=in_year) ) THEN \n\
+        IF offering_count > 0 THEN \n\
+            # check enrollment places, free seats go to the head of the waitlist first \n\
+            IF ( (select Enrollment<MaxEnrollment from uosoffering where UoSCode=in_course_id and Semester=in_semester and Year=in_year) and (next_student IS NULL or next_student=in_student_id) ) THEN \n\
                 # if already taken \n\
                 IF(SELECT EXISTS( select UoSCode from transcript where UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id and Grade is not null and Grade != 'F')) THEN \n\
                     SELECT 'Already taken'; \n\
@@ -152,6 +420,7 @@ void db_createProcedures()
                             # Enrollment attribute of the corresponding course shall be increased by one. \n\
                             insert into transcript(StudId, UoSCode, Semester, Year, Grade) VALUES(in_student_id, in_course_id, in_semester, in_year, null); \n\
                             update uosoffering set Enrollment=Enrollment+1 where UoSCode=in_course_id and Semester=in_semester and Year=in_year; \n\
+                            delete from waitlist where UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id; \n\
                             SELECT 'OK'; \n\
                             COMMIT; \n\
                         END IF; \n\
@@ -175,15 +444,27 @@ void db_createProcedures()
     
     string withdraw_sql = "CREATE DEFINER=`root`@`localhost` PROCEDURE `withdraw_student`(IN in_course_id char(8), IN in_semester char(2), IN in_year int, IN in_student_id int) \
     BEGIN \n\
+        DECLARE offering_count int; \n\
+        DECLARE next_student int DEFAULT NULL; \n\
         # start transaction \n\
         START TRANSACTION; \n\
+        # lock offering before any other read so the reads below see the latest commits, \n\
+        # enroll_student and waitlist_student take the same lock. offering_count is only the target of the locking read \n\
+        SELECT COUNT(*) INTO offering_count FROM uosoffering WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year FOR UPDATE; \n\
         # check if student is enrolled \n\
         IF( SELECT EXISTS( select UoSCode from transcript where UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id)) THEN \n\
             # check if withdraw possible \n\
             IF( SELECT EXISTS( select UoSCode from transcript where UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id and Grade is null)) THEN \n\
                 # Transcript entry shall be removed and the current Enrollment number of the corresponding course shall be decreased by one. \n\
                 DELETE FROM transcript WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id; \n\
-                UPDATE uosoffering SET Enrollment=Enrollment-1 where UoSCode=in_course_id and Semester=in_semester and Year=in_year; \n\
+                # first student in waitlist takes the free seat, Enrollment stays the same, empty waitlist leaves next_student NULL \n\
+                SELECT StudId INTO next_student FROM waitlist WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year ORDER BY Id LIMIT 1 FOR UPDATE; \n\
+                IF next_student IS NOT NULL THEN \n\
+                    DELETE FROM waitlist WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=next_student; \n\
+                    INSERT INTO transcript(StudId, UoSCode, Semester, Year, Grade) VALUES(next_student, in_course_id, in_semester, in_year, null); \n\
+                ELSE \n\
+                    UPDATE uosoffering SET Enrollment=Enrollment-1 where UoSCode=in_course_id and Semester=in_semester and Year=in_year; \n\
+                END IF; \n\
                 SELECT 'OK'; \n\
                 COMMIT; \n\
             ELSE \n\
@@ -191,27 +472,81 @@ void db_createProcedures()
                 ROLLBACK; \n\
             END IF; \n\
         ELSE \n\
-            SELECT 'Not enrolled'; \n\
-            ROLLBACK; \n\
+            # not enrolled, leave waitlist if waiting \n\
+            IF( SELECT EXISTS( select StudId from waitlist where UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id)) THEN \n\
+                DELETE FROM waitlist WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id; \n\
+                SELECT 'Removed from waitlist'; \n\
+                COMMIT; \n\
+            ELSE \n\
+                SELECT 'Not enrolled'; \n\
+                ROLLBACK; \n\
+            END IF; \n\
         END IF; \n\
     END";
     mysql_query(&mysql, withdraw_sql.c_str());
     if(mysql_errno( connection ) || mysql_warning_count(connection))
         cout << mysql_error(&mysql) << endl;
+    
+    // STORED PROCEDURE : waitlist
+    mysql_query(&mysql, "DROP procedure IF EXISTS `waitlist_student`;");
+    
+    string join_waitlist_sql = "CREATE DEFINER=`root`@`localhost` PROCEDURE `waitlist_student`(IN in_course_id char(8), IN in_semester char(2), IN in_year int, IN in_student_id int) \n\
+        BEGIN \n\
+        DECLARE prerequisites varchar(256); \n\
+        DECLARE entry_id int; \n\
+        DECLARE offering_count int; \n\
+        START TRANSACTION; \n\
+        # lock offering before any other read, enroll_student and withdraw_student take the same lock \n\
+        SELECT COUNT(*) INTO offering_count FROM uosoffering WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year FOR UPDATE; \n\
+        # check course exists \n\
+        IF offering_count > 0 THEN \n\
+            # if already enrolled \n\
+            IF(SELECT EXISTS(select UoSCode from transcript where UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id)) THEN \n\
+                SELECT 'Already enrolled'; \n\
+                ROLLBACK; \n\
+            # free seat and nobody waiting, enroll directly \n\
+            ELSEIF ( (select Enrollment<MaxEnrollment from uosoffering where UoSCode=in_course_id and Semester=in_semester and Year=in_year) \n\
+                     and NOT EXISTS(select StudId from waitlist where UoSCode=in_course_id and Semester=in_semester and Year=in_year) ) THEN \n\
+                SELECT 'Seats available, enroll instead'; \n\
+                ROLLBACK; \n\
+            ELSE \n\
+                # check prerequisites, promotion from waitlist does not check them again \n\
+                SELECT GROUP_CONCAT(r.PrereqUoSCode SEPARATOR ' ') into prerequisites FROM requires r \n\
+                LEFT JOIN transcript t on (t.UoSCode=r.PrereqUoSCode and t.StudId=in_student_id) \n\
+                WHERE r.uoscode=in_course_id and (t.grade is null or t.grade='F' or t.grade='I'); \n\
+                IF prerequisites IS NOT NULL THEN \n\
+                    SELECT CONCAT('Prerequisites not met: ', prerequisites); \n\
+                    ROLLBACK; \n\
+                ELSE \n\
+                    # joining twice keeps the original place \n\
+                    INSERT IGNORE INTO waitlist(StudId, UoSCode, Semester, Year) VALUES(in_student_id, in_course_id, in_semester, in_year); \n\
+                    SET entry_id = (SELECT Id FROM waitlist WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year and StudId=in_student_id); \n\
+                    SELECT CONCAT('Waitlisted, position ', COUNT(*)) FROM waitlist WHERE UoSCode=in_course_id and Semester=in_semester and Year=in_year and Id<=entry_id; \n\
+                    COMMIT; \n\
+                END IF; \n\
+            END IF; \n\
+        ELSE \n\
+            SELECT 'Course not offered'; \n\
+            ROLLBACK; \n\
+        END IF; \n\
+        END";
+    mysql_query(&mysql, join_waitlist_sql.c_str());
+    if(mysql_errno( connection ) || mysql_warning_count(connection))
+        cout << mysql_error(&mysql) << endl;
 }
 
 /**
- * Query courses available for enrollment in current quarter
+ * Query courses available for enrollment in given quarter
  */
-vector<Course> db_queryEnrollmentCourses()
+vector<Course> db_queryEnrollmentCourses(const string& semester, int year)
 {
+    TraceCall trace("db_queryEnrollmentCourses", {semester, to_string(year)});
     vector<Course> courses;
     
-    string semester = getCurrentSemester();
-    int year = getCurrentYear();
-    
-    // Query courses available for enrollment in current quarter
-    MYSQL_RES* result = execSqlQuery("SELECT U.UoSCode, U.DeptId, U.UoSName, U.Credits, V.Enrollment, V.Maxenrollment, f.Name, L.ClassTime, L.ClassroomId \
+    // Query courses available for enrollment in given quarter
+    MYSQL_RES* result = execSqlQuery("SELECT U.UoSCode, U.DeptId, U.UoSName, U.Credits, V.Enrollment, V.Maxenrollment, f.Name, L.ClassTime, L.ClassroomId, \
+                                     (SELECT GROUP_CONCAT(R.PrereqUoSCode SEPARATOR ' ') FROM requires R WHERE R.UoSCode=U.UoSCode), \
+                                     (SELECT COUNT(*) FROM waitlist W WHERE W.UoSCode=V.UoSCode AND W.Semester=V.Semester AND W.Year=V.Year) \
                                      FROM unitofstudy U, uosoffering V \
                                      LEFT JOIN faculty f on (f.Id=V.InstructorId) \
                                      LEFT JOIN lecture L on (L.UoSCode=V.UoSCode and L.Semester=V.Semester and L.Year=V.Year) \
@@ -231,10 +566,24 @@ vector<Course> db_queryEnrollmentCourses()
             c1.lecturer = row[6] ? row[6] : "";
             c1.classtime = row[7] ? row[7] : "";
             c1.classroom = row[8] ? row[8] : "";
+            
+            // prerequisites are space separated
+            string prerequisites = row[9] ? row[9] : "";
+            for(size_t pos = 0; pos < prerequisites.size(); )
+            {
+                size_t end = prerequisites.find(' ', pos);
+                if(end == string::npos)
+                    end = prerequisites.size();
+                if(end > pos)
+                    c1.prerequisites.push_back(prerequisites.substr(pos, end - pos));
+                pos = end + 1;
+            }
+            c1.waitlistlength = atoi(row[10]);
             courses.push_back(c1);
         }
         mysql_free_result(result);
     }
+    trace.rows = courses.size();
     return courses;
 }
 
@@ -243,6 +592,7 @@ vector<Course> db_queryEnrollmentCourses()
  */
 vector<Course> db_queryStudentTranscript(int user_id)
 {
+    TraceCall trace("db_queryStudentTranscript", {to_string(user_id)});
     vector<Course> courses;
     
     // The course details should include:
@@ -279,19 +629,18 @@ vector<Course> db_queryStudentTranscript(int user_id)
         mysql_free_result(result);
     }
     
+    trace.rows = courses.size();
     return courses;
 }
 
 /**
- * Query currently enrolled courses list for student
+ * Query enrolled courses list for student in given quarter
  */
-vector<Course> db_queryCurrentCourses(int user_id)
+vector<Course> db_queryCurrentCourses(int user_id, const string& semester, int year)
 {
+    TraceCall trace("db_queryCurrentCourses", {to_string(user_id), semester, to_string(year)});
     vector<Course> courses;
     
-    string semester = getCurrentSemester();
-    int year = getCurrentYear();
-    
     // Query list of current courses. Course Id and Name3213
     MYSQL_RES* result = execSqlQuery("SELECT T.UoSCode, U.UoSName \
                                      FROM transcript T, unitofstudy U \
@@ -309,6 +658,38 @@ vector<Course> db_queryCurrentCourses(int user_id)
         }
         mysql_free_result(result);
     }
+    trace.rows = courses.size();
+    return courses;
+}
+
+/**
+ * Query waitlisted courses for student in given quarter with position in each waitlist
+ */
+vector<Course> db_queryWaitlist(int user_id, const string& semester, int year)
+{
+    TraceCall trace("db_queryWaitlist", {to_string(user_id), semester, to_string(year)});
+    vector<Course> courses;
+    
+    // position is the number of entries queued before or at student's entry
+    MYSQL_RES* result = execSqlQuery("SELECT W.UoSCode, U.UoSName, \
+                                     (SELECT COUNT(*) FROM waitlist X WHERE X.UoSCode=W.UoSCode AND X.Semester=W.Semester AND X.Year=W.Year AND X.Id<=W.Id) \
+                                     FROM waitlist W, unitofstudy U \
+                                     WHERE W.UoSCode=U.UoSCode AND W.StudId='"+to_string(user_id)+"' AND W.Semester='"+semester+"' \
+                                     AND W.Year='"+to_string(year)+"' ORDER BY W.Id");
+    if(result)
+    {
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(result)))
+        {
+            Course c1;
+            c1.id = row[0];
+            c1.name = row[1];
+            c1.waitlistposition = atoi(row[2]);
+            courses.push_back(c1);
+        }
+        mysql_free_result(result);
+    }
+    trace.rows = courses.size();
     return courses;
 }
 
@@ -317,6 +698,7 @@ vector<Course> db_queryCurrentCourses(int user_id)
  */
 Student db_queryStudent(int user_id)
 {
+    TraceCall trace("db_queryStudent", {to_string(user_id)});
     Student student;
     string sql = "SELECT Name, Address FROM student where Id=" + to_string(user_id);
     MYSQL_RES *result = execSqlQuery(sql);
@@ -327,6 +709,7 @@ Student db_queryStudent(int user_id)
         student.name = row[0];
         student.address = row[1];
         mysql_free_result(result);
+        trace.rows = 1;
     }
     return student;
 }
@@ -336,6 +719,8 @@ Student db_queryStudent(int user_id)
  */
 void db_changePassword(int user_id, const string& password)
 {
+    TraceCall trace("db_changePassword", {to_string(user_id), password});
+    
     // escape string
     char value[100];
     mysql_real_escape_string(&mysql, value, password.c_str(), password.size());
@@ -351,6 +736,8 @@ void db_changePassword(int user_id, const string& password)
  */
 void db_changeAddress(int user_id, const string& address)
 {
+    TraceCall trace("db_changeAddress", {to_string(user_id), address});
+    
     // escape string
     char value[100];
     mysql_real_escape_string(&mysql, value, address.c_str(), address.size());
@@ -366,6 +753,8 @@ void db_changeAddress(int user_id, const string& address)
  */
 int db_login(const string& username, const string& password)
 {
+    TraceCall trace("db_login", {username, password});
+    
     // select student id with username and password provided
     // return student id
     int ID = 0;
@@ -376,46 +765,81 @@ int db_login(const string& username, const string& password)
         MYSQL_ROW row = mysql_fetch_row(result);
         ID = atoi(row[0]);
         mysql_free_result(result);
+        trace.rows = 1;
     }
     return ID;
 }
 
 /**
- * Enroll into selected course
+ * Enroll into selected course, returns message from stored procedure
  */
-void db_enroll_into(const string& course_id, const string& semester, int year, int user_id)
+string db_enroll_into(const string& course_id, const string& semester, int year, int user_id)
 {
+    TraceCall trace("db_enroll_into", {course_id, semester, to_string(year), to_string(user_id)});
+    
+    string response;
     MYSQL_RES* result = execSqlQuery("CALL enroll_student('"+course_id+"', '"+semester+"', "+to_string(year)+", "+to_string(user_id)+")");
     if(result)
     {
         MYSQL_ROW row = mysql_fetch_row(result);
         
-        // print message from stored procedure
-        string response = row[0];
-        cout << response;
+        // message from stored procedure
+        response = row[0];
+        trace.rows = 1;
+        trace.response = response;
         
         mysql_next_result(&mysql);
         mysql_free_result(result);
     }
+    return response;
 }
 
 /**
- * Withdraw from course
+ * Withdraw from course, returns message from stored procedure
  */
-void db_withdraw(const string& course_id, const string& semester, int year, int user_id)
+string db_withdraw(const string& course_id, const string& semester, int year, int user_id)
 {
+    TraceCall trace("db_withdraw", {course_id, semester, to_string(year), to_string(user_id)});
+    
+    string response;
     MYSQL_RES* result = execSqlQuery("CALL withdraw_student('"+course_id+"', '"+semester+"', "+to_string(year)+", "+to_string(user_id)+")");
     if(result)
     {
         MYSQL_ROW row = mysql_fetch_row(result);
         
-        // print message from stored procedure
-        string response = row[0];
-        cout << response;
+        // message from stored procedure
+        response = row[0];
+        trace.rows = 1;
+        trace.response = response;
+        
+        mysql_next_result(&mysql);
+        mysql_free_result(result);
+    }
+    return response;
+}
+
+/**
+ * Join waitlist of a full course, returns message from stored procedure
+ */
+string db_joinWaitlist(const string& course_id, const string& semester, int year, int user_id)
+{
+    TraceCall trace("db_joinWaitlist", {course_id, semester, to_string(year), to_string(user_id)});
+    
+    string response;
+    MYSQL_RES* result = execSqlQuery("CALL waitlist_student('"+course_id+"', '"+semester+"', "+to_string(year)+", "+to_string(user_id)+")");
+    if(result)
+    {
+        MYSQL_ROW row = mysql_fetch_row(result);
+        
+        // message from stored procedure
+        response = row[0];
+        trace.rows = 1;
+        trace.response = response;
         
         mysql_next_result(&mysql);
         mysql_free_result(result);
     }
+    return response;
 }
 
 /**
@@ -423,6 +847,7 @@ void db_withdraw(const string& course_id, const string& semester, int year, int
  */
 Course db_queryCourseDetails(const string& course_id, int user_id)
 {
+    TraceCall trace("db_queryCourseDetails", {course_id, to_string(user_id)});
     Course c1;
     
     // The course details should include:
@@ -457,6 +882,8 @@ Course db_queryCourseDetails(const string& course_id, int user_id)
         }
         mysql_free_result(result);
     }
+    // one course per call, same as replay counts it
+    trace.rows = c1.id.empty() ? 0 : 1;
     return c1;
 }
 
@@ -522,29 +949,93 @@ void showTranscriptScreen(int user_id)
 
 void showEnrollScreen(int user_id)
 {
-    cout << "\n\n\n";
-    cout << "-----------------------------" << endl;
-    cout << "* Enrollment, available courses: " << endl;
-    cout << "-----------------------------" << endl;
+    // catalog and transcript are loaded once, searching works on loaded data only
+    // transcript is the only extra query, it gives passed courses for the prerequisites filter
+    CourseIndex index(db_queryEnrollmentCourses(getCurrentSemester(), getCurrentYear()));
     
-    vector<Course> courses = db_queryEnrollmentCourses();
-    for(int i=0;i<courses.size();i++)
+    CourseFilter filter;
+    vector<Course> transcript = db_queryStudentTranscript(user_id);
+    for(size_t i=0;i<transcript.size();i++)
     {
-        cout << " " << courses[i].id << " " << courses[i].name << "(" << courses[i].credits << "), " << courses[i].lecturer << ", " << courses[i].classtime << ", " << courses[i].classroom << ",  " << courses[i].enrollment << "/" << courses[i].maxenrollment << endl;
+        const string& grade = transcript[i].grade;
+        if(!grade.empty() && grade != "F" && grade != "I")
+            filter.passed.insert(transcript[i].id);
     }
     
-    cout << "Enter course id: ";
-    
-    string courseid;
-    cin >> courseid;
-    
-    string semester = getCurrentSemester();
-    int year = getCurrentYear();
-    
-    db_enroll_into(courseid, semester, year, user_id);
-    
-    cout << endl << endl << "Press any key to continue...";
-    system("read");
+    string query;
+    while(true)
+    {
+        cout << "\n\n\n";
+        cout << "-----------------------------" << endl;
+        cout << "* Enrollment, available courses: " << endl;
+        cout << "-----------------------------" << endl;
+        
+        if(!query.empty())
+            cout << "Search: " << query << endl;
+        
+        vector<size_t> found = index.search(query, filter);
+        for(size_t i=0;i<found.size();i++)
+        {
+            const Course& c = index.courses[found[i]];
+            cout << " " << c.id << " " << c.name << "(" << c.credits << "), " << c.lecturer << ", " << c.classtime << ", " << c.classroom << ",  " << c.enrollment << "/" << c.maxenrollment;
+            if(c.waitlistlength > 0)
+                cout << ", waitlist " << c.waitlistlength;
+            cout << endl;
+        }
+        if(found.empty())
+            cout << " No courses found" << endl;
+        
+        cout << endl << "Choose menu option:" << endl;
+        cout << " 1) Search by code, name, department or lecturer" << endl;
+        cout << " 2) Only courses with free seats [" << (filter.freeSeats ? "on" : "off") << "]" << endl;
+        cout << " 3) Only courses with prerequisites met [" << (filter.prerequisitesMet ? "on" : "off") << "]" << endl;
+        cout << " 4) Enroll" << endl;
+        cout << " 5) Back to previous menu" << endl;
+        cout << ":";
+        
+        int option = 0;
+        cin >> option;
+        
+        if(option == 1)
+        {
+            cout << "Enter search text (empty to show all): ";
+            getline (cin, query);
+            getline (cin, query);
+        }
+        else if(option == 2)
+            filter.freeSeats = !filter.freeSeats;
+        else if(option == 3)
+            filter.prerequisitesMet = !filter.prerequisitesMet;
+        else if(option == 4)
+        {
+            cout << "Enter course id: ";
+            
+            string courseid;
+            cin >> courseid;
+            
+            string semester = getCurrentSemester();
+            int year = getCurrentYear();
+            
+            string response = db_enroll_into(courseid, semester, year, user_id);
+            cout << response;
+            
+            // full course, offer a place in the waitlist instead of retrying
+            if(response == "Not seats available")
+            {
+                cout << endl << "Join waitlist? (y/n): ";
+                string answer;
+                cin >> answer;
+                if(answer == "y" || answer == "Y")
+                    cout << db_joinWaitlist(courseid, semester, year, user_id);
+            }
+            
+            cout << endl << endl << "Press any key to continue...";
+            system("read");
+            break;
+        }
+        else if(option == 5)
+            break;
+    }
 }
 
 void showWithdrawScreen(int user_id)
@@ -554,12 +1045,21 @@ void showWithdrawScreen(int user_id)
     cout << "* Withdraw, current courses: " << endl;
     cout << "-----------------------------" << endl;
     
-    vector<Course> courses = db_queryCurrentCourses(user_id);
+    vector<Course> courses = db_queryCurrentCourses(user_id, getCurrentSemester(), getCurrentYear());
     cout << endl << "Your current courses:" << endl;
     for(int i=0;i<courses.size();i++)
         cout << "  " << courses[i].id << " " << courses[i].name << endl;
     cout << endl;
     
+    vector<Course> waitlist = db_queryWaitlist(user_id, getCurrentSemester(), getCurrentYear());
+    if(!waitlist.empty())
+    {
+        cout << "Your waitlisted courses:" << endl;
+        for(size_t i=0;i<waitlist.size();i++)
+            cout << "  " << waitlist[i].id << " " << waitlist[i].name << ", position " << waitlist[i].waitlistposition << endl;
+        cout << endl;
+    }
+    
     cout << "Enter course id: ";
     
     string courseid;
@@ -568,7 +1068,7 @@ void showWithdrawScreen(int user_id)
     string semester = getCurrentSemester();
     int year = getCurrentYear();
     
-    db_withdraw(courseid, semester, year, user_id);
+    cout << db_withdraw(courseid, semester, year, user_id);
     
     cout << endl << endl << "Press any key to continue...";
     system("read");
@@ -631,12 +1131,21 @@ void showStudentScreen(int user_id)
         cout << "* Student information for " << student.name << endl;
         cout << "-----------------------------" << endl;
         
-        vector<Course> courses = db_queryCurrentCourses(user_id);
+        vector<Course> courses = db_queryCurrentCourses(user_id, getCurrentSemester(), getCurrentYear());
         cout << endl << "Your current courses:" << endl;
         for(int i=0;i<courses.size();i++)
             cout << "  " << courses[i].id << " " << courses[i].name << endl;
         cout << endl;
         
+        vector<Course> waitlist = db_queryWaitlist(user_id, getCurrentSemester(), getCurrentYear());
+        if(!waitlist.empty())
+        {
+            cout << "Your waitlisted courses:" << endl;
+            for(size_t i=0;i<waitlist.size();i++)
+                cout << "  " << waitlist[i].id << " " << waitlist[i].name << ", position " << waitlist[i].waitlistposition << endl;
+            cout << endl;
+        }
+        
         cout << "Choose menu option:" << endl;
         cout << " 1) Transcript" << endl;
         cout << " 2) Enroll" << endl;
@@ -684,13 +1193,433 @@ void showLoginScreen()
     }
 }
 
-int main()
+/**
+ * Single db_* call loaded from a trace file
+ */
+struct TraceEvent {
+    TraceEvent() {
+        ts = 0;
+        us = 0;
+        rows = 0;
+    }
+    string session;
+    long long ts;
+    string op;
+    vector<string> args;
+    long long us;
+    size_t rows;
+    string response;
+};
+
+/**
+ * Parse JSON string starting at pos, pos is moved past the closing quote
+ */
+bool parseJsonString(const string& line, size_t& pos, string& out)
 {
-    mysql_init(&mysql);
-    connection = mysql_real_connect(&mysql, "localhost", "root", "123",
-                                    "project3-nudb", 0, 0, 0);
+    if(pos >= line.size() || line[pos] != '"')
+        return false;
+    
+    for(pos++; pos < line.size(); pos++)
+    {
+        char c = line[pos];
+        if(c == '"')
+        {
+            pos++;
+            return true;
+        }
+        if(c != '\\')
+        {
+            out += c;
+            continue;
+        }
+        
+        // escape sequence
+        if(++pos >= line.size())
+            return false;
+        c = line[pos];
+        if(c == 'n')
+            out += '\n';
+        else if(c == 't')
+            out += '\t';
+        else if(c == 'u' && pos + 4 < line.size())
+        {
+            // only control characters are written as \uXXXX by jsonEscape()
+            out += (char)strtol(line.substr(pos+1, 4).c_str(), NULL, 16);
+            pos += 4;
+        }
+        else
+            out += c;
+    }
+    return false;
+}
+
+/**
+ * Parse one trace line written by TraceCall
+ */
+bool parseTraceLine(const string& line, TraceEvent& event)
+{
+    size_t pos = line.find('{');
+    if(pos == string::npos)
+        return false;
+    pos++;
+    
+    while(pos < line.size())
+    {
+        pos = line.find_first_not_of(" \t,", pos);
+        if(pos == string::npos)
+            return false;
+        if(line[pos] == '}')
+            return !event.op.empty();
+        
+        string key;
+        if(!parseJsonString(line, pos, key))
+            return false;
+        pos = line.find_first_not_of(" \t:", pos);
+        if(pos == string::npos)
+            return false;
+        
+        if(key == "op" || key == "session" || key == "response")
+        {
+            string value;
+            if(!parseJsonString(line, pos, value))
+                return false;
+            
+            if(key == "op")
+                event.op = value;
+            else if(key == "session")
+                event.session = value;
+            else
+                event.response = value;
+        }
+        else if(key == "args")
+        {
+            if(line[pos] != '[')
+                return false;
+            pos++;
+            while(true)
+            {
+                pos = line.find_first_not_of(" \t,", pos);
+                if(pos == string::npos)
+                    return false;
+                if(line[pos] == ']')
+                {
+                    pos++;
+                    break;
+                }
+                string arg;
+                if(!parseJsonString(line, pos, arg))
+                    return false;
+                event.args.push_back(arg);
+            }
+        }
+        else
+        {
+            char* end = NULL;
+            long long value = strtoll(line.c_str() + pos, &end, 10);
+            if(end == line.c_str() + pos)
+                return false;
+            pos = end - line.c_str();
+            
+            if(key == "ts")
+                event.ts = value;
+            else if(key == "us")
+                event.us = value;
+            else if(key == "rows")
+                event.rows = value;
+        }
+    }
+    return false;
+}
+
+/**
+ * Execute recorded call again, returns number of result rows,
+ * stored procedure message is returned in response
+ */
+size_t replayCall(const TraceEvent& event, string& response)
+{
+    const vector<string>& a = event.args;
+    const string& op = event.op;
+    
+    if(op == "db_queryEnrollmentCourses" && a.size() == 2)
+        return db_queryEnrollmentCourses(a[0], atoi(a[1].c_str())).size();
+    if(op == "db_queryStudentTranscript" && a.size() == 1)
+        return db_queryStudentTranscript(atoi(a[0].c_str())).size();
+    if(op == "db_queryCurrentCourses" && a.size() == 3)
+        return db_queryCurrentCourses(atoi(a[0].c_str()), a[1], atoi(a[2].c_str())).size();
+    if(op == "db_queryWaitlist" && a.size() == 3)
+        return db_queryWaitlist(atoi(a[0].c_str()), a[1], atoi(a[2].c_str())).size();
+    if(op == "db_queryStudent" && a.size() == 1)
+        return db_queryStudent(atoi(a[0].c_str())).id ? 1 : 0;
+    if(op == "db_changePassword" && a.size() == 2)
+    {
+        db_changePassword(atoi(a[0].c_str()), a[1]);
+        return 0;
+    }
+    if(op == "db_changeAddress" && a.size() == 2)
+    {
+        db_changeAddress(atoi(a[0].c_str()), a[1]);
+        return 0;
+    }
+    if(op == "db_login" && a.size() == 2)
+        return db_login(a[0], a[1]) ? 1 : 0;
+    if(op == "db_enroll_into" && a.size() == 4)
+    {
+        response = db_enroll_into(a[0], a[1], atoi(a[2].c_str()), atoi(a[3].c_str()));
+        return response.empty() ? 0 : 1;
+    }
+    if(op == "db_withdraw" && a.size() == 4)
+    {
+        response = db_withdraw(a[0], a[1], atoi(a[2].c_str()), atoi(a[3].c_str()));
+        return response.empty() ? 0 : 1;
+    }
+    if(op == "db_joinWaitlist" && a.size() == 4)
+    {
+        response = db_joinWaitlist(a[0], a[1], atoi(a[2].c_str()), atoi(a[3].c_str()));
+        return response.empty() ? 0 : 1;
+    }
+    if(op == "db_queryCourseDetails" && a.size() == 2)
+        return db_queryCourseDetails(a[0], atoi(a[1].c_str())).id.empty() ? 0 : 1;
+    
+    cout << "Unknown trace operation: " << op << endl;
+    return 0;
+}
+
+/**
+ * Replay worker: opens its own connection and takes whole sessions in order of their first call.
+ * Calls of one session run in trace order on this connection, concurrency is across sessions only.
+ * With speed > 0 every event waits for its recorded offset divided by speed,
+ * with speed 0 events run back to back.
+ */
+void replayWorker(const vector<TraceEvent>& events, const vector<vector<size_t> >& sessions, atomic<size_t>& next,
+                  chrono::steady_clock::time_point start, double speed,
+                  vector<long long>& latency, vector<size_t>& rows, vector<string>& responses)
+{
+    mysql_thread_init();
+    
+    if(db_connect())
+    {
+        size_t s;
+        while((s = next++) < sessions.size())
+        {
+            for(size_t k=0;k<sessions[s].size();k++)
+            {
+                size_t i = sessions[s][k];
+                if(speed > 0)
+                    this_thread::sleep_until(start + chrono::microseconds((long long)((events[i].ts - events[0].ts) / speed)));
+                
+                chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+                rows[i] = replayCall(events[i], responses[i]);
+                latency[i] = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+            }
+        }
+        mysql_close(&mysql);
+    }
+    else
+        cout << "Unable to connect!" << endl;
+    
+    mysql_thread_end();
+}
+
+/**
+ * Returns p-th percentile (0..100) of latency list
+ */
+long long percentile(vector<long long> values, double p)
+{
+    if(values.empty())
+        return 0;
+    sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0 * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+/**
+ * Replay trace file against local database and print per-operation latency
+ * compared to the recorded baseline
+ */
+int replayTrace(const string& filename, double speed, int threads)
+{
+    ifstream file(filename.c_str());
+    if(!file)
+    {
+        cout << "Unable to open trace " << filename << endl;
+        return 1;
+    }
+    
+    vector<TraceEvent> events;
+    string line;
+    int lineno = 0;
+    while(getline(file, line))
+    {
+        lineno++;
+        if(line.empty())
+            continue;
+        
+        TraceEvent event;
+        if(parseTraceLine(line, event))
+            events.push_back(event);
+        else
+            cout << filename << ":" << lineno << ": invalid trace line, skipped" << endl;
+    }
+    
+    if(events.empty())
+    {
+        cout << "Trace " << filename << " is empty" << endl;
+        return 1;
+    }
+    
+    // several recorded sessions can be concatenated into one file
+    stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.ts < b.ts; });
+    
+    // group calls by session, sessions are ordered by their first call
+    vector<vector<size_t> > sessions;
+    map<string, size_t> sessionIndex;
+    for(size_t i=0;i<events.size();i++)
+    {
+        if(!sessionIndex.count(events[i].session))
+        {
+            sessionIndex[events[i].session] = sessions.size();
+            sessions.push_back(vector<size_t>());
+        }
+        sessions[sessionIndex[events[i].session]].push_back(i);
+    }
+    
+    if(threads < 1)
+        threads = 1;
+    
+    cout << "Replaying " << events.size() << " calls from " << sessions.size() << " session(s) with " << threads << " connection(s), ";
+    if(speed > 0)
+        cout << "speed x" << speed << endl;
+    else
+        cout << "as fast as possible" << endl;
+    
+    mysql_library_init(0, NULL, NULL);
+    
+    // fresh local database needs the same procedures and tables as an interactive run
+    if(!db_connect())
+    {
+        cout << "Unable to connect!" << endl;
+        mysql_library_end();
+        return 1;
+    }
+    db_createProcedures();
+    mysql_close(&mysql);
+    
+    vector<long long> latency(events.size(), -1);
+    vector<size_t> rows(events.size(), 0);
+    vector<string> responses(events.size());
+    atomic<size_t> next(0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    
+    vector<thread> workers;
+    for(int i=0;i<threads;i++)
+        workers.push_back(thread(replayWorker, cref(events), cref(sessions), ref(next), start, speed, ref(latency), ref(rows), ref(responses)));
+    for(size_t i=0;i<workers.size();i++)
+        workers[i].join();
+    
+    long long elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    
+    mysql_library_end();
+    
+    // group latencies per operation
+    map<string, vector<long long> > recorded, replayed;
+    map<string, int> mismatched;
+    size_t executed = 0;
+    for(size_t i=0;i<events.size();i++)
+    {
+        if(latency[i] < 0)
+            continue;
+        executed++;
+        recorded[events[i].op].push_back(events[i].us);
+        replayed[events[i].op].push_back(latency[i]);
+        if(rows[i] != events[i].rows || responses[i] != events[i].response)
+            mismatched[events[i].op]++;
+    }
+    
+    cout << endl;
+    cout << left << setw(28) << "Operation" << right << setw(7) << "Calls"
+         << setw(10) << "Rec p50" << setw(10) << "Rec p95"
+         << setw(10) << "p50" << setw(10) << "p95" << setw(10) << "p99"
+         << setw(8) << "Ratio" << setw(10) << "Diff" << endl;
+    
+    for(map<string, vector<long long> >::iterator it = replayed.begin(); it != replayed.end(); ++it)
+    {
+        const vector<long long>& base = recorded[it->first];
+        long long baseP50 = percentile(base, 50);
+        long long p50 = percentile(it->second, 50);
+        
+        cout << left << setw(28) << it->first << right << setw(7) << it->second.size()
+             << setw(10) << baseP50 << setw(10) << percentile(base, 95)
+             << setw(10) << p50 << setw(10) << percentile(it->second, 95) << setw(10) << percentile(it->second, 99)
+             << setw(8) << fixed << setprecision(2) << (baseP50 > 0 ? (double)p50 / baseP50 : 0.0)
+             << setw(10) << mismatched[it->first] << endl;
+    }
+    
+    cout << endl << "Latencies in microseconds, ratio is replay p50 / recorded p50." << endl;
+    cout << "Diff counts calls whose row count or stored procedure response differs from the trace." << endl;
+    cout << executed << " of " << events.size() << " calls executed in " << elapsed / 1000 << " ms";
+    if(elapsed > 0)
+        cout << ", " << setprecision(1) << executed * 1000000.0 / elapsed << " calls/s";
+    cout << endl;
+    
+    return executed == events.size() ? 0 : 1;
+}
+
+/**
+ * Parse --speed factor, only positive numbers are accepted
+ */
+bool parseSpeed(const char* text, double& speed)
+{
+    char* end = NULL;
+    double value = strtod(text, &end);
+    if(end == text || *end != '\0' || !(value > 0))
+        return false;
+    speed = value;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    string recordFile, replayFile;
+    double speed = 1.0;
+    int threads = 1;
+    
+    for(int i=1;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg == "--record" && i+1 < argc)
+            recordFile = argv[++i];
+        else if(arg == "--replay" && i+1 < argc)
+            replayFile = argv[++i];
+        else if(arg == "--speed" && i+1 < argc && parseSpeed(argv[i+1], speed))
+            i++;
+        else if(arg == "--fast")
+            speed = 0;
+        else if(arg == "--threads" && i+1 < argc)
+            threads = atoi(argv[++i]);
+        else
+        {
+            cout << "Usage: " << argv[0] << " [--record <trace>]" << endl;
+            cout << "       " << argv[0] << " --replay <trace> [--speed <factor> | --fast] [--threads <n>]" << endl;
+            return 1;
+        }
+    }
+    
+    // replay mode, no interactive session
+    if(!replayFile.empty())
+        return replayTrace(replayFile, speed, threads);
+    
+    if(!recordFile.empty())
+    {
+        traceSession = to_string(getpid()) + "-" + to_string(getTimestampMicros());
+        traceFile.open(recordFile.c_str(), ios::app);
+        if(!traceFile)
+        {
+            cout << "Unable to open trace " << recordFile << endl;
+            return 1;
+        }
+    }
     
-    if (connection != NULL)
+    if (db_connect())
     {
         // create storage procedures and triggers
         db_createProcedures();